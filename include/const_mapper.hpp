@@ -24,10 +24,14 @@
 #pragma once
 
 #include <array>
+#include <bitset>
+#include <cstdint>
 #include <optional>
 #include <stdexcept>
+#include <string_view>
 #include <tuple>
 #include <type_traits>
+#include <vector>
 
 namespace const_mapper {
 
@@ -85,6 +89,11 @@ class ConstMapper {
   template <class... Types>
   constexpr auto pattern_match(const std::tuple<Types...> &pattern) const;
 
+  /**
+   * Array elements in original order.
+   */
+  constexpr const std::array<Tuple, N> &data() const;
+
  private:
   std::array<Tuple, N> map_data_;
 
@@ -142,6 +151,9 @@ class ConstMapper {
   constexpr auto get_result_impl(const Tuple &value_tuple) const;
 
   static constexpr auto tuple_size();
+
+  template <std::size_t, class...>
+  friend class OverlayMapper;
 };
 
 template <class T>
@@ -185,6 +197,470 @@ class Range {
   CompareType compare_type_ = CompareType::Any;
   T value_;
 };
+
+/**
+ * Runtime patch of `ConstMapper`.
+ * Holds small delta (added, replaced and erased rows) over base mapper, without copying base.
+ * Rows in delta are consulted in insertion order before rows of base. Replaced and erased rows of base are skipped.
+ * If delta is empty, lookup is same as base.
+ */
+template <std::size_t N, class... Args>
+class OverlayMapper {
+ public:
+  using Mapper = ConstMapper<N, Args...>;
+  using Tuple = typename Mapper::Tuple;
+
+  /**
+   * @param base mapper to be patched. must outlive this overlay.
+   */
+  explicit OverlayMapper(const Mapper &base);
+
+  /**
+   * Temporary mapper is not allowed, because this overlay refers to base.
+   */
+  explicit OverlayMapper(const Mapper &&base) = delete;
+
+  /**
+   * Add new row.
+   */
+  void add(const Tuple &tuple);
+
+  /**
+   * Replace row of base. Replacing same row again overwrites previous replacement.
+   * @param row index of row in base.
+   */
+  void replace(std::size_t row, const Tuple &tuple);
+
+  /**
+   * Erase row of base.
+   * @param row index of row in base.
+   */
+  void erase(std::size_t row);
+
+  /**
+   * Remove all of delta.
+   */
+  void clear();
+
+  /**
+   * @return true if there is no delta.
+   */
+  bool empty() const;
+
+  /**
+   * Simple convert.
+   * @see ConstMapper::to
+   */
+  template <std::size_t i_to, std::size_t i_from, class Key>
+  auto to(const Key &key) const;
+
+  /**
+   * Type matching conversion.
+   * @see ConstMapper::to
+   */
+  template <class To, class From, class Key = From>
+  To to(const Key &key) const;
+
+  /**
+   * Pattern matching conversion.
+   * @see ConstMapper::pattern_match
+   */
+  template <class... Types>
+  auto pattern_match(const std::tuple<Types...> &pattern) const;
+
+ private:
+  const Mapper *base_;
+  std::vector<Tuple> delta_;               // added and replaced rows.
+  std::vector<std::size_t> delta_rows_;    // base row replaced by each element of `delta_`, or N for added row.
+  std::bitset<N> masked_;                  // replaced or erased rows of base.
+  std::size_t masked_count_ = 0;
+
+  /**
+   * @return first row that match is true, delta first. nullptr if not found.
+   */
+  template <class Match>
+  const Tuple *find(const Match &match) const;
+
+  void check_row(std::size_t row) const;
+};
+
+/**
+ * Trie with left-child right-sibling links. Used to build `PrefixTrie` and count its nodes.
+ * Siblings are sorted by label. Node 0 is root, so 0 is used as `no link`.
+ *
+ * @param Capacity max number of nodes.
+ */
+template <std::size_t Capacity>
+class PrefixTrieBuilder {
+ public:
+  static constexpr std::uint32_t kNone = 0;
+
+  constexpr PrefixTrieBuilder();
+
+  /**
+   * @return node of key.
+   */
+  constexpr std::uint32_t insert(std::string_view key);
+
+  constexpr std::uint32_t size() const;
+  constexpr char label(std::uint32_t node) const;
+  constexpr std::uint32_t first_child(std::uint32_t node) const;
+  constexpr std::uint32_t next_sibling(std::uint32_t node) const;
+
+ private:
+  std::uint32_t size_;
+  std::array<char, Capacity> labels_;
+  std::array<std::uint32_t, Capacity> first_children_;
+  std::array<std::uint32_t, Capacity> next_siblings_;
+};
+
+/**
+ * Trie of `std::string_view` key column for longest prefix matching. Built at compile-time.
+ * Nodes are stored in flat arrays in breadth-first order, so children of a node are contiguous.
+ *
+ * @param i_from index of key column. Type of key column must be `std::string_view`.
+ * @param Nodes number of nodes. @see count_prefix_trie_nodes
+ * @see make_prefix_trie
+ */
+template <std::size_t i_from, std::size_t Nodes, std::size_t N, class... Args>
+class PrefixTrie {
+ public:
+  using Mapper = ConstMapper<N, Args...>;
+  using Tuple = typename Mapper::Tuple;
+
+  /**
+   * @param mapper mapper to be indexed. must outlive this trie.
+   */
+  explicit constexpr PrefixTrie(const Mapper &mapper);
+
+  /**
+   * Temporary mapper is not allowed, because this trie refers to mapper.
+   */
+  explicit PrefixTrie(const Mapper &&mapper) = delete;
+
+  /**
+   * Longest prefix matching.
+   * @param i_to index of return value.
+   * @return i_to value of array element whose key is the longest prefix of query. If two or more elements have same
+   * key, pick-up first element.
+   */
+  template <std::size_t i_to>
+  constexpr auto prefix_match(std::string_view query) const;
+
+  /**
+   * Longest prefix matching.
+   * @param To type of return value. if there are 2 or more `To` value in `Tuple`, pick-up first value.
+   * @return `To` value of array element whose key is the longest prefix of query.
+   */
+  template <class To>
+  constexpr To prefix_match(std::string_view query) const;
+
+ private:
+  static constexpr std::uint32_t kNoRow = static_cast<std::uint32_t>(N);
+
+  const Mapper *mapper_;
+  std::array<char, Nodes> labels_;                   // character of edge from parent.
+  std::array<std::uint32_t, Nodes> first_children_;  // index of first child. children are sorted by label.
+  std::array<std::uint16_t, Nodes> child_counts_;
+  std::array<std::uint32_t, Nodes> rows_;  // first row whose key ends at this node, or kNoRow.
+
+  /**
+   * @return row of longest prefix, or kNoRow if not found.
+   */
+  constexpr std::uint32_t find(std::string_view query) const;
+};
+
+/**
+ * Upper bound of number of nodes of `PrefixTrie` of i_from column. 1 + total length of keys.
+ */
+template <std::size_t i_from, std::size_t N, class... Args>
+constexpr std::size_t prefix_trie_capacity(const ConstMapper<N, Args...> &mapper);
+
+/**
+ * Count nodes of `PrefixTrie` of i_from column, including root.
+ * @param Capacity must be `prefix_trie_capacity<i_from>(mapper)` or larger.
+ */
+template <std::size_t i_from, std::size_t Capacity, std::size_t N, class... Args>
+constexpr std::size_t count_prefix_trie_nodes(const ConstMapper<N, Args...> &mapper);
+
+/**
+ * Count nodes of `PrefixTrie` of i_from column, including root. Capacity is computed at compile-time.
+ * @param map `ConstMapper` with static storage duration. e.g. `static constexpr` variable.
+ */
+template <const auto &map, std::size_t i_from>
+constexpr std::size_t count_prefix_trie_nodes();
+
+/**
+ * Build `PrefixTrie` of i_from column.
+ * @param Nodes number of nodes. must be `count_prefix_trie_nodes<map, i_from>()`.
+ */
+template <std::size_t i_from, std::size_t Nodes, std::size_t N, class... Args>
+constexpr auto make_prefix_trie(const ConstMapper<N, Args...> &mapper);
+
+/**
+ * Temporary mapper is not allowed, because `PrefixTrie` refers to mapper.
+ */
+template <std::size_t i_from, std::size_t Nodes, std::size_t N, class... Args>
+constexpr auto make_prefix_trie(const ConstMapper<N, Args...> &&mapper) = delete;
+
+/**
+ * Build `PrefixTrie` of i_from column. Number of nodes is counted at compile-time.
+ * @param map `ConstMapper` with static storage duration. e.g. `static constexpr` variable.
+ */
+template <const auto &map, std::size_t i_from>
+constexpr auto make_prefix_trie();
+
+/**
+ * Compile-time simple convert. Key is passed as template argument, so missing key is compile error instead of
+ * `std::out_of_range`.
+ * @param map `ConstMapper` with static storage duration. e.g. `static constexpr` variable.
+ * @param i_to index of return value.
+ * @param i_from index of key value.
+ * @param key integral or enum key.
+ * @return first i_to value that i_from value match with array element.
+ */
+template <const auto &map, std::size_t i_to, std::size_t i_from, auto key,
+          std::enable_if_t<std::is_integral_v<decltype(key)> || std::is_enum_v<decltype(key)>,
+                           std::nullptr_t> = nullptr>
+constexpr auto to_ct();
+
+/**
+ * Compile-time simple convert for other keys (e.g. string).
+ * @param key key with static storage duration. e.g. `static constexpr std::string_view` variable.
+ * @see to_ct
+ */
+template <const auto &map, std::size_t i_to, std::size_t i_from, const auto &key,
+          std::enable_if_t<!std::is_integral_v<std::remove_cv_t<std::remove_reference_t<decltype(key)>>> &&
+                               !std::is_enum_v<std::remove_cv_t<std::remove_reference_t<decltype(key)>>>,
+                           std::nullptr_t> = nullptr>
+constexpr auto to_ct();
+
+/**
+ * Compile-time type matching conversion. Key is passed as template argument, so missing key is compile error instead
+ * of `std::out_of_range`.
+ * @param map `ConstMapper` with static storage duration. e.g. `static constexpr` variable.
+ * @param To type of return value. if there are 2 or more `To` value in `Tuple`, pick-up first value.
+ * @param From type of key value. if there are 2 or more `From` value in `Tuple`, pick-up first value.
+ * @param key integral or enum key.
+ * @return first `To` value that `From` value match with array element.
+ */
+template <const auto &map, class To, class From, auto key,
+          std::enable_if_t<std::is_integral_v<decltype(key)> || std::is_enum_v<decltype(key)>,
+                           std::nullptr_t> = nullptr>
+constexpr To to_ct();
+
+/**
+ * Compile-time type matching conversion for other keys (e.g. string).
+ * @param key key with static storage duration. e.g. `static constexpr std::string_view` variable.
+ * @see to_ct
+ */
+template <const auto &map, class To, class From, const auto &key,
+          std::enable_if_t<!std::is_integral_v<std::remove_cv_t<std::remove_reference_t<decltype(key)>>> &&
+                               !std::is_enum_v<std::remove_cv_t<std::remove_reference_t<decltype(key)>>>,
+                           std::nullptr_t> = nullptr>
+constexpr To to_ct();
+
+/**
+ * Compile-time pattern matching conversion. Unmatched pattern is compile error instead of `std::out_of_range`.
+ * @param map `ConstMapper` with static storage duration. e.g. `static constexpr` variable.
+ * @param pattern tuple with static storage duration. e.g. `static constexpr auto pattern = std::make_tuple(...)`.
+ * @see ConstMapper::pattern_match
+ */
+template <const auto &map, const auto &pattern>
+constexpr auto pattern_match_ct();
+
+/**
+ * Statistics of `LearnedIndex` model.
+ */
+struct LearnedIndexStats {
+  std::size_t segments;    // number of linear segments.
+  std::size_t max_error;   // max distance between predicted position and actual position.
+  std::size_t model_size;  // bytes used by model. sorted keys and rows are not included.
+};
+
+/**
+ * Learned index for integral key column.
+ * Keys are sorted at construction and piecewise-linear model predicts position of key.
+ * Lookup searches only error window around predicted position, instead of whole table.
+ *
+ * @param i_from index of key column. Type of key column must be integral.
+ * @param Segments max number of linear segments of model.
+ * @see make_learned_index
+ */
+template <std::size_t i_from, std::size_t Segments, std::size_t N, class... Args>
+class LearnedIndex {
+ public:
+  using Mapper = ConstMapper<N, Args...>;
+  using Tuple = typename Mapper::Tuple;
+  using Key = std::tuple_element_t<i_from, Tuple>;
+
+  /**
+   * @param mapper mapper to be indexed. must outlive this index.
+   */
+  explicit constexpr LearnedIndex(const Mapper &mapper);
+
+  /**
+   * Temporary mapper is not allowed, because this index refers to mapper.
+   */
+  explicit LearnedIndex(const Mapper &&mapper) = delete;
+
+  /**
+   * Simple convert.
+   * @param i_to index of return value.
+   * @return first i_to value that key match with array element.
+   */
+  template <std::size_t i_to>
+  constexpr auto to(const Key &key) const;
+
+  /**
+   * Type matching conversion.
+   * @param To type of return value. if there are 2 or more `To` value in `Tuple`, pick-up first value.
+   * @return first `To` value that key match with array element.
+   */
+  template <class To>
+  constexpr To to(const Key &key) const;
+
+  constexpr LearnedIndexStats stats() const;
+
+ private:
+  static constexpr std::size_t kSegments = Segments < N ? Segments : N;
+
+  const Mapper *mapper_;
+  std::array<Key, N> keys_;           // sorted keys.
+  std::array<std::size_t, N> rows_;   // original row of each sorted key.
+  std::array<Key, kSegments> segment_keys_;
+  std::array<std::size_t, kSegments + 1> segment_begins_;
+  std::array<double, kSegments> slopes_;
+  std::array<std::size_t, kSegments> errors_;
+
+  /**
+   * @return position of first key in `keys_`, or N if not found.
+   */
+  constexpr std::size_t find(const Key &key) const;
+
+  constexpr std::size_t predict(std::size_t segment, const Key &key) const;
+
+  constexpr std::size_t lower_bound(std::size_t first, std::size_t last, const Key &key) const;
+
+  /**
+   * Heap sort `keys_` and `rows_` by (key, row). std::sort is not constexpr in C++17.
+   */
+  constexpr void sort();
+
+  constexpr void sift_down(std::size_t root, std::size_t size);
+
+  constexpr bool less(std::size_t i, std::size_t j) const;
+
+  constexpr void swap(std::size_t i, std::size_t j);
+};
+
+/**
+ * Build `LearnedIndex` of i_from column.
+ */
+template <std::size_t i_from, std::size_t Segments = 64, std::size_t N, class... Args>
+constexpr auto make_learned_index(const ConstMapper<N, Args...> &mapper);
+
+/**
+ * Temporary mapper is not allowed, because `LearnedIndex` refers to mapper.
+ */
+template <std::size_t i_from, std::size_t Segments = 64, std::size_t N, class... Args>
+constexpr auto make_learned_index(const ConstMapper<N, Args...> &&mapper) = delete;
+
+/**
+ * Blocked bloom filter of key column.
+ * Rejects most of absent keys by one memory access before scanning all array elements.
+ * All bits of one key are set in one 64bit word.
+ *
+ * @param i_from index of key column. Type of key column must be integral, enum or `std::string_view`.
+ * @param BitsPerKey bits of filter per array element. Larger value makes false positive rate lower.
+ * 8 bits: about 3%, 12 bits: about 1.2%, 16 bits: about 0.5%.
+ * @see make_key_filter
+ */
+template <std::size_t i_from, std::size_t BitsPerKey, std::size_t N, class... Args>
+class KeyFilter {
+ public:
+  using Mapper = ConstMapper<N, Args...>;
+  using Tuple = typename Mapper::Tuple;
+  using Column = std::tuple_element_t<i_from, Tuple>;
+
+  /**
+   * @param mapper mapper to be filtered. must outlive this filter.
+   */
+  explicit constexpr KeyFilter(const Mapper &mapper);
+
+  /**
+   * Temporary mapper is not allowed, because this filter refers to mapper.
+   */
+  explicit KeyFilter(const Mapper &&mapper) = delete;
+
+  /**
+   * @return false if key is not in key column. true if key may be in key column.
+   */
+  template <class Key>
+  constexpr bool may_contain(const Key &key) const;
+
+  /**
+   * Simple convert without exception. Absent key is rejected by filter before scanning.
+   * @param i_to index of return value.
+   * @return first i_to value that key match with array element, or `std::nullopt` if not found.
+   */
+  template <std::size_t i_to, class Key>
+  constexpr auto find(const Key &key) const;
+
+  /**
+   * Type matching conversion without exception. Absent key is rejected by filter before scanning.
+   * @param To type of return value. if there are 2 or more `To` value in `Tuple`, pick-up first value.
+   * @return first `To` value that key match with array element, or `std::nullopt` if not found.
+   */
+  template <class To, class Key = Column>
+  constexpr std::optional<To> find(const Key &key) const;
+
+  /**
+   * Simple convert. Same as `ConstMapper::to` except absent key is rejected by filter.
+   * @param i_to index of return value.
+   * @return first i_to value that key match with array element.
+   */
+  template <std::size_t i_to, class Key>
+  constexpr auto to(const Key &key) const;
+
+  /**
+   * Type matching conversion. Same as `ConstMapper::to` except absent key is rejected by filter.
+   * @param To type of return value. if there are 2 or more `To` value in `Tuple`, pick-up first value.
+   * @return first `To` value that key match with array element.
+   */
+  template <class To, class Key = Column>
+  constexpr To to(const Key &key) const;
+
+ private:
+  static constexpr std::size_t kWords = (N * BitsPerKey + 63) / 64;
+  // optimal number of hashes is BitsPerKey * ln2. 6bits are used for each hash.
+  static constexpr std::size_t kHashes =
+      BitsPerKey * 69 / 100 < 1 ? 1 : (BitsPerKey * 69 / 100 > 10 ? 10 : BitsPerKey * 69 / 100);
+
+  const Mapper *mapper_;
+  std::array<std::uint64_t, kWords> words_;
+
+  template <class Key>
+  static constexpr std::uint64_t hash(const Key &key);
+
+  static constexpr std::uint64_t mix(std::uint64_t value);
+
+  static constexpr std::size_t word_index(std::uint64_t hash);
+
+  static constexpr std::uint64_t bit_mask(std::uint64_t hash);
+};
+
+/**
+ * Build `KeyFilter` of i_from column.
+ */
+template <std::size_t i_from, std::size_t BitsPerKey = 12, std::size_t N, class... Args>
+constexpr auto make_key_filter(const ConstMapper<N, Args...> &mapper);
+
+/**
+ * Temporary mapper is not allowed, because `KeyFilter` refers to mapper.
+ */
+template <std::size_t i_from, std::size_t BitsPerKey = 12, std::size_t N, class... Args>
+constexpr auto make_key_filter(const ConstMapper<N, Args...> &&mapper) = delete;
 }  // namespace const_mapper
 
 namespace {
@@ -332,6 +808,11 @@ constexpr auto ConstMapper<N, Args...>::pattern_match(const std::tuple<Types...>
   return pattern_match_impl(pattern);
 }
 
+template <std::size_t N, class... Args>
+constexpr const std::array<typename ConstMapper<N, Args...>::Tuple, N> &ConstMapper<N, Args...>::data() const {
+  return map_data_;
+}
+
 template <std::size_t N, class... Args>
 template <class... Types>
 constexpr auto ConstMapper<N, Args...>::pattern_match_impl(const std::tuple<Types...> &pattern) const {
@@ -392,4 +873,642 @@ constexpr auto ConstMapper<N, Args...>::get_result_impl(const Tuple &value_tuple
     return std::tuple_cat(std::tuple(std::get<index>(value_tuple)), get_result_impl<i, PatternTuple>(value_tuple));
   }
 }
+
+template <const auto &map, std::size_t i_to, std::size_t i_from, auto key,
+          std::enable_if_t<std::is_integral_v<decltype(key)> || std::is_enum_v<decltype(key)>,
+                           std::nullptr_t>>
+constexpr auto to_ct() {
+  constexpr auto value = map.template to<i_to, i_from>(key);
+  return value;
+}
+
+template <const auto &map, std::size_t i_to, std::size_t i_from, const auto &key,
+          std::enable_if_t<!std::is_integral_v<std::remove_cv_t<std::remove_reference_t<decltype(key)>>> &&
+                               !std::is_enum_v<std::remove_cv_t<std::remove_reference_t<decltype(key)>>>,
+                           std::nullptr_t>>
+constexpr auto to_ct() {
+  constexpr auto value = map.template to<i_to, i_from>(key);
+  return value;
+}
+
+template <const auto &map, class To, class From, auto key,
+          std::enable_if_t<std::is_integral_v<decltype(key)> || std::is_enum_v<decltype(key)>,
+                           std::nullptr_t>>
+constexpr To to_ct() {
+  constexpr To value = map.template to<To, From>(key);
+  return value;
+}
+
+template <const auto &map, class To, class From, const auto &key,
+          std::enable_if_t<!std::is_integral_v<std::remove_cv_t<std::remove_reference_t<decltype(key)>>> &&
+                               !std::is_enum_v<std::remove_cv_t<std::remove_reference_t<decltype(key)>>>,
+                           std::nullptr_t>>
+constexpr To to_ct() {
+  constexpr To value = map.template to<To, From>(key);
+  return value;
+}
+
+template <const auto &map, const auto &pattern>
+constexpr auto pattern_match_ct() {
+  constexpr auto value = map.pattern_match(pattern);
+  return value;
+}
+
+template <std::size_t i_from, std::size_t Segments, std::size_t N, class... Args>
+constexpr LearnedIndex<i_from, Segments, N, Args...>::LearnedIndex(const Mapper &mapper)
+    : mapper_(&mapper), keys_(), rows_(), segment_keys_(), segment_begins_(), slopes_(), errors_() {
+  static_assert(std::is_integral_v<Key>, "Key column must be integral.");
+  static_assert(Segments > 0, "Segments must grater than 0.");
+
+  for (std::size_t i = 0; i < N; ++i) {
+    keys_[i] = std::get<i_from>(mapper.data()[i]);
+    rows_[i] = i;
+  }
+  sort();
+
+  for (std::size_t s = 0; s <= kSegments; ++s) {
+    segment_begins_[s] = s * N / kSegments;
+  }
+
+  for (std::size_t s = 0; s < kSegments; ++s) {
+    const auto begin = segment_begins_[s];
+    const auto end = segment_begins_[s + 1];
+    // fit line between first key of this segment and first key of next segment.
+    const auto last = end < N ? end : N - 1;
+    const auto dx = static_cast<double>(keys_[last]) - static_cast<double>(keys_[begin]);
+
+    segment_keys_[s] = keys_[begin];
+    slopes_[s] = dx > 0 ? static_cast<double>(last - begin) / dx : 0.0;
+
+    for (auto i = begin; i < end; ++i) {
+      if (i > 0 && keys_[i - 1] == keys_[i]) {
+        continue;  // only first key of duplicates is searched.
+      }
+      const auto predicted = predict(s, keys_[i]);
+      const auto error = predicted > i ? predicted - i : i - predicted;
+      if (error > errors_[s]) {
+        errors_[s] = error;
+      }
+    }
+  }
+}
+
+template <std::size_t i_from, std::size_t Segments, std::size_t N, class... Args>
+template <std::size_t i_to>
+constexpr auto LearnedIndex<i_from, Segments, N, Args...>::to(const Key &key) const {
+  static_assert(i_to < std::tuple_size_v<Tuple>, "i_to out of tuple range");
+
+  const auto position = find(key);
+  if (position == N) {
+    throw std::out_of_range("key not found.");
+  }
+  return std::get<i_to>(mapper_->data()[rows_[position]]);
+}
+
+template <std::size_t i_from, std::size_t Segments, std::size_t N, class... Args>
+template <class To>
+constexpr To LearnedIndex<i_from, Segments, N, Args...>::to(const Key &key) const {
+  constexpr auto i_to = tuple_index<Tuple, To, 0>();
+  static_assert(i_to < std::tuple_size_v<Tuple>, "Tuple does not contain `To` element.");
+
+  return to<i_to>(key);
+}
+
+template <std::size_t i_from, std::size_t Segments, std::size_t N, class... Args>
+constexpr LearnedIndexStats LearnedIndex<i_from, Segments, N, Args...>::stats() const {
+  std::size_t max_error = 0;
+  for (const auto error : errors_) {
+    if (error > max_error) {
+      max_error = error;
+    }
+  }
+  return {kSegments, max_error, sizeof(segment_keys_) + sizeof(segment_begins_) + sizeof(slopes_) + sizeof(errors_)};
+}
+
+template <std::size_t i_from, std::size_t Segments, std::size_t N, class... Args>
+constexpr std::size_t LearnedIndex<i_from, Segments, N, Args...>::find(const Key &key) const {
+  // last segment whose first key is less than key. the first `key` is in this segment or at its end.
+  std::size_t first = 0;
+  std::size_t count = kSegments;
+  while (count > 0) {
+    const auto step = count / 2;
+    if (segment_keys_[first + step] < key) {
+      first += step + 1;
+      count -= step + 1;
+    } else {
+      count = step;
+    }
+  }
+  const auto segment = first > 0 ? first - 1 : 0;
+
+  const auto begin = segment_begins_[segment];
+  const auto end = segment_begins_[segment + 1];
+  const auto predicted = predict(segment, key);
+  // +1 for keys not in table, which fall between two predictions.
+  const auto error = errors_[segment] + 1;
+  const auto window_begin = predicted > begin + error ? predicted - error : begin;
+  const auto window_end = predicted + error + 1 < end ? predicted + error + 1 : end;
+
+  auto position = lower_bound(window_begin, window_end, key);
+  if (position == window_begin && window_begin > begin && !(keys_[window_begin - 1] < key)) {
+    position = lower_bound(begin, window_begin, key);
+  } else if (position == window_end && window_end < end && keys_[window_end] < key) {
+    position = lower_bound(window_end, end, key);
+  }
+
+  return (position < N && keys_[position] == key) ? position : N;
+}
+
+template <std::size_t i_from, std::size_t Segments, std::size_t N, class... Args>
+constexpr std::size_t LearnedIndex<i_from, Segments, N, Args...>::predict(std::size_t segment, const Key &key) const {
+  const auto begin = segment_begins_[segment];
+  const auto end = segment_begins_[segment + 1];
+  const auto offset = slopes_[segment] * (static_cast<double>(key) - static_cast<double>(segment_keys_[segment]));
+
+  if (!(offset > 0)) {
+    return begin;
+  } else if (offset >= static_cast<double>(end - begin)) {
+    return end;
+  } else {
+    return begin + static_cast<std::size_t>(offset);
+  }
+}
+
+template <std::size_t i_from, std::size_t Segments, std::size_t N, class... Args>
+constexpr std::size_t LearnedIndex<i_from, Segments, N, Args...>::lower_bound(std::size_t first, std::size_t last,
+                                                                                const Key &key) const {
+  auto count = last - first;
+  while (count > 0) {
+    const auto step = count / 2;
+    if (keys_[first + step] < key) {
+      first += step + 1;
+      count -= step + 1;
+    } else {
+      count = step;
+    }
+  }
+  return first;
+}
+
+template <std::size_t i_from, std::size_t Segments, std::size_t N, class... Args>
+constexpr void LearnedIndex<i_from, Segments, N, Args...>::sort() {
+  for (auto i = N / 2; i > 0; --i) {
+    sift_down(i - 1, N);
+  }
+  for (auto size = N; size > 1; --size) {
+    swap(0, size - 1);
+    sift_down(0, size - 1);
+  }
+}
+
+template <std::size_t i_from, std::size_t Segments, std::size_t N, class... Args>
+constexpr void LearnedIndex<i_from, Segments, N, Args...>::sift_down(std::size_t root, std::size_t size) {
+  while (2 * root + 1 < size) {
+    auto child = 2 * root + 1;
+    if (child + 1 < size && less(child, child + 1)) {
+      ++child;
+    }
+    if (!less(root, child)) {
+      return;
+    }
+    swap(root, child);
+    root = child;
+  }
+}
+
+template <std::size_t i_from, std::size_t Segments, std::size_t N, class... Args>
+constexpr bool LearnedIndex<i_from, Segments, N, Args...>::less(std::size_t i, std::size_t j) const {
+  return keys_[i] < keys_[j] || (keys_[i] == keys_[j] && rows_[i] < rows_[j]);
+}
+
+template <std::size_t i_from, std::size_t Segments, std::size_t N, class... Args>
+constexpr void LearnedIndex<i_from, Segments, N, Args...>::swap(std::size_t i, std::size_t j) {
+  const auto key = keys_[i];
+  keys_[i] = keys_[j];
+  keys_[j] = key;
+
+  const auto row = rows_[i];
+  rows_[i] = rows_[j];
+  rows_[j] = row;
+}
+
+template <std::size_t i_from, std::size_t Segments, std::size_t N, class... Args>
+constexpr auto make_learned_index(const ConstMapper<N, Args...> &mapper) {
+  return LearnedIndex<i_from, Segments, N, Args...>(mapper);
+}
+
+template <std::size_t i_from, std::size_t BitsPerKey, std::size_t N, class... Args>
+constexpr KeyFilter<i_from, BitsPerKey, N, Args...>::KeyFilter(const Mapper &mapper) : mapper_(&mapper), words_() {
+  static_assert(BitsPerKey > 0, "BitsPerKey must grater than 0.");
+
+  for (const auto &tuple : mapper.data()) {
+    const auto h = hash(std::get<i_from>(tuple));
+    words_[word_index(h)] |= bit_mask(h);
+  }
+}
+
+template <std::size_t i_from, std::size_t BitsPerKey, std::size_t N, class... Args>
+template <class Key>
+constexpr bool KeyFilter<i_from, BitsPerKey, N, Args...>::may_contain(const Key &key) const {
+  const auto h = hash(key);
+  const auto mask = bit_mask(h);
+  return (words_[word_index(h)] & mask) == mask;
+}
+
+template <std::size_t i_from, std::size_t BitsPerKey, std::size_t N, class... Args>
+template <std::size_t i_to, class Key>
+constexpr auto KeyFilter<i_from, BitsPerKey, N, Args...>::find(const Key &key) const {
+  static_assert(i_to < std::tuple_size_v<Tuple>, "i_to out of tuple range");
+  using Value = std::tuple_element_t<i_to, Tuple>;
+
+  if (!may_contain(key)) {
+    return std::optional<Value>();
+  }
+  for (const auto &tuple : mapper_->data()) {
+    if (std::get<i_from>(tuple) == key) {
+      return std::optional<Value>(std::get<i_to>(tuple));
+    }
+  }
+  return std::optional<Value>();
+}
+
+template <std::size_t i_from, std::size_t BitsPerKey, std::size_t N, class... Args>
+template <class To, class Key>
+constexpr std::optional<To> KeyFilter<i_from, BitsPerKey, N, Args...>::find(const Key &key) const {
+  constexpr auto i_to = tuple_index<Tuple, To, 0>();
+  static_assert(i_to < std::tuple_size_v<Tuple>, "Tuple does not contain `To` element.");
+
+  return find<i_to>(key);
+}
+
+template <std::size_t i_from, std::size_t BitsPerKey, std::size_t N, class... Args>
+template <std::size_t i_to, class Key>
+constexpr auto KeyFilter<i_from, BitsPerKey, N, Args...>::to(const Key &key) const {
+  const auto value = find<i_to>(key);
+  if (!value) {
+    throw std::out_of_range("key not found.");
+  }
+  return *value;
+}
+
+template <std::size_t i_from, std::size_t BitsPerKey, std::size_t N, class... Args>
+template <class To, class Key>
+constexpr To KeyFilter<i_from, BitsPerKey, N, Args...>::to(const Key &key) const {
+  constexpr auto i_to = tuple_index<Tuple, To, 0>();
+  static_assert(i_to < std::tuple_size_v<Tuple>, "Tuple does not contain `To` element.");
+
+  return to<i_to>(key);
+}
+
+template <std::size_t i_from, std::size_t BitsPerKey, std::size_t N, class... Args>
+template <class Key>
+constexpr std::uint64_t KeyFilter<i_from, BitsPerKey, N, Args...>::hash(const Key &key) {
+  if constexpr (std::is_enum_v<Column>) {
+    // convert to column type first, so that key is hashed same as `==` compares.
+    return mix(static_cast<std::uint64_t>(static_cast<std::underlying_type_t<Column>>(static_cast<Column>(key))));
+  } else if constexpr (std::is_integral_v<Column>) {
+    return mix(static_cast<std::uint64_t>(static_cast<Column>(key)));
+  } else if constexpr (std::is_same_v<Column, std::string_view>) {
+    // FNV-1a
+    std::uint64_t value = 14695981039346656037ull;
+    for (const auto c : std::string_view(key)) {
+      value = (value ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+    }
+    return mix(value);
+  } else {
+    static_assert(std::is_same_v<Column, std::string_view>, "Key column must be integral, enum or std::string_view.");
+    return 0;
+  }
+}
+
+template <std::size_t i_from, std::size_t BitsPerKey, std::size_t N, class... Args>
+constexpr std::uint64_t KeyFilter<i_from, BitsPerKey, N, Args...>::mix(std::uint64_t value) {
+  // finalizer of splitmix64
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+  return value ^ (value >> 31);
+}
+
+template <std::size_t i_from, std::size_t BitsPerKey, std::size_t N, class... Args>
+constexpr std::size_t KeyFilter<i_from, BitsPerKey, N, Args...>::word_index(std::uint64_t hash) {
+  // map upper 32bits to [0, kWords) without division.
+  return static_cast<std::size_t>(((hash >> 32) * kWords) >> 32);
+}
+
+template <std::size_t i_from, std::size_t BitsPerKey, std::size_t N, class... Args>
+constexpr std::uint64_t KeyFilter<i_from, BitsPerKey, N, Args...>::bit_mask(std::uint64_t hash) {
+  // remix so that bit positions are independent of word_index.
+  const auto bits = mix(hash);
+  std::uint64_t mask = 0;
+  for (std::size_t i = 0; i < kHashes; ++i) {
+    mask |= std::uint64_t{1} << ((bits >> (6 * i)) & 63);
+  }
+  return mask;
+}
+
+template <std::size_t i_from, std::size_t BitsPerKey, std::size_t N, class... Args>
+constexpr auto make_key_filter(const ConstMapper<N, Args...> &mapper) {
+  return KeyFilter<i_from, BitsPerKey, N, Args...>(mapper);
+}
+
+template <std::size_t N, class... Args>
+OverlayMapper<N, Args...>::OverlayMapper(const Mapper &base) : base_(&base) {}
+
+template <std::size_t N, class... Args>
+void OverlayMapper<N, Args...>::add(const Tuple &tuple) {
+  delta_.push_back(tuple);
+  delta_rows_.push_back(N);
+}
+
+template <std::size_t N, class... Args>
+void OverlayMapper<N, Args...>::replace(std::size_t row, const Tuple &tuple) {
+  check_row(row);
+
+  if (masked_[row]) {
+    for (std::size_t i = 0; i < delta_rows_.size(); ++i) {
+      if (delta_rows_[i] == row) {
+        delta_[i] = tuple;
+        return;
+      }
+    }
+  } else {
+    masked_[row] = true;
+    ++masked_count_;
+  }
+  delta_.push_back(tuple);
+  delta_rows_.push_back(row);
+}
+
+template <std::size_t N, class... Args>
+void OverlayMapper<N, Args...>::erase(std::size_t row) {
+  check_row(row);
+
+  if (masked_[row]) {
+    for (std::size_t i = 0; i < delta_rows_.size(); ++i) {
+      if (delta_rows_[i] == row) {
+        delta_.erase(delta_.begin() + i);
+        delta_rows_.erase(delta_rows_.begin() + i);
+        return;
+      }
+    }
+  } else {
+    masked_[row] = true;
+    ++masked_count_;
+  }
+}
+
+template <std::size_t N, class... Args>
+void OverlayMapper<N, Args...>::clear() {
+  delta_.clear();
+  delta_rows_.clear();
+  masked_.reset();
+  masked_count_ = 0;
+}
+
+template <std::size_t N, class... Args>
+bool OverlayMapper<N, Args...>::empty() const {
+  return delta_.empty() && masked_count_ == 0;
+}
+
+template <std::size_t N, class... Args>
+template <std::size_t i_to, std::size_t i_from, class Key>
+auto OverlayMapper<N, Args...>::to(const Key &key) const {
+  static_assert(i_to < std::tuple_size_v<Tuple>, "i_to out of tuple range");
+  static_assert(i_from < std::tuple_size_v<Tuple>, "i_from out of tuple range");
+
+  if (empty()) {
+    return base_->template to<i_to, i_from>(key);
+  }
+
+  const auto *tuple = find([&key](const Tuple &t) { return std::get<i_from>(t) == key; });
+  if (tuple == nullptr) {
+    throw std::out_of_range("key not found.");
+  }
+  return std::get<i_to>(*tuple);
+}
+
+template <std::size_t N, class... Args>
+template <class To, class From, class Key>
+To OverlayMapper<N, Args...>::to(const Key &key) const {
+  constexpr auto i_to = tuple_index<Tuple, To, 0>();
+  constexpr auto i_from = tuple_index<Tuple, From, 0>();
+  static_assert(i_to < std::tuple_size_v<Tuple>, "Tuple does not contain `To` element.");
+  static_assert(i_from < std::tuple_size_v<Tuple>, "Tuple does not contain `From` element.");
+
+  return to<i_to, i_from>(key);
+}
+
+template <std::size_t N, class... Args>
+template <class... Types>
+auto OverlayMapper<N, Args...>::pattern_match(const std::tuple<Types...> &pattern) const {
+  static_assert(std::tuple_size_v<Tuple> == sizeof...(Types), "tuple size dose not match.");
+  static_assert(tuple_contains<std::tuple<Types...>, Result>(), "No Result value.");
+
+  if (empty()) {
+    return base_->pattern_match(pattern);
+  }
+
+  const auto *tuple =
+      find([this, &pattern](const Tuple &t) { return base_->template check_pattern_match<0>(t, pattern); });
+  if (tuple == nullptr) {
+    throw std::out_of_range("key not found.");
+  }
+  return un_tuple_if_one_element(base_->template get_result<std::tuple<Types...>>(*tuple));
+}
+
+template <std::size_t N, class... Args>
+template <class Match>
+const typename OverlayMapper<N, Args...>::Tuple *OverlayMapper<N, Args...>::find(const Match &match) const {
+  for (const auto &tuple : delta_) {
+    if (match(tuple)) {
+      return &tuple;
+    }
+  }
+
+  // masked rows are few. check mask only for matched rows.
+  const auto &data = base_->data();
+  for (std::size_t row = 0; row < N; ++row) {
+    if (match(data[row]) && !masked_[row]) {
+      return &data[row];
+    }
+  }
+  return nullptr;
+}
+
+template <std::size_t N, class... Args>
+void OverlayMapper<N, Args...>::check_row(std::size_t row) const {
+  if (!(row < N)) {
+    throw std::out_of_range("row out of range.");
+  }
+}
+
+template <std::size_t i_from, std::size_t Nodes, std::size_t N, class... Args>
+constexpr PrefixTrie<i_from, Nodes, N, Args...>::PrefixTrie(const Mapper &mapper)
+    : mapper_(&mapper), labels_(), first_children_(), child_counts_(), rows_() {
+  static_assert(std::is_same_v<std::tuple_element_t<i_from, Tuple>, std::string_view>,
+                "Key column must be std::string_view.");
+  static_assert(Nodes > 0 && Nodes < UINT32_MAX, "Nodes out of range.");
+
+  // build trie with left-child right-sibling links, then relayout in breadth-first order.
+  PrefixTrieBuilder<Nodes> builder;
+  std::array<std::uint32_t, Nodes> rows{};
+  for (std::size_t i = 0; i < Nodes; ++i) {
+    rows[i] = kNoRow;
+  }
+  for (std::size_t row = 0; row < N; ++row) {
+    const auto node = builder.insert(std::get<i_from>(mapper.data()[row]));
+    if (rows[node] == kNoRow) {
+      rows[node] = static_cast<std::uint32_t>(row);
+    }
+  }
+  if (builder.size() != Nodes) {
+    throw std::logic_error("Nodes is too large.");
+  }
+
+  std::array<std::uint32_t, Nodes> order{};  // original node of each breadth-first index.
+  std::uint32_t tail = 1;
+  for (std::uint32_t head = 0; head < Nodes; ++head) {
+    const auto node = order[head];
+    labels_[head] = builder.label(node);
+    rows_[head] = rows[node];
+    first_children_[head] = tail;
+    for (auto child = builder.first_child(node); child != builder.kNone; child = builder.next_sibling(child)) {
+      order[tail] = child;
+      ++tail;
+    }
+    child_counts_[head] = static_cast<std::uint16_t>(tail - first_children_[head]);
+  }
+}
+
+template <std::size_t i_from, std::size_t Nodes, std::size_t N, class... Args>
+template <std::size_t i_to>
+constexpr auto PrefixTrie<i_from, Nodes, N, Args...>::prefix_match(std::string_view query) const {
+  static_assert(i_to < std::tuple_size_v<Tuple>, "i_to out of tuple range");
+
+  const auto row = find(query);
+  if (row == kNoRow) {
+    throw std::out_of_range("key not found.");
+  }
+  return std::get<i_to>(mapper_->data()[row]);
+}
+
+template <std::size_t i_from, std::size_t Nodes, std::size_t N, class... Args>
+template <class To>
+constexpr To PrefixTrie<i_from, Nodes, N, Args...>::prefix_match(std::string_view query) const {
+  constexpr auto i_to = tuple_index<Tuple, To, 0>();
+  static_assert(i_to < std::tuple_size_v<Tuple>, "Tuple does not contain `To` element.");
+
+  return prefix_match<i_to>(query);
+}
+
+template <std::size_t i_from, std::size_t Nodes, std::size_t N, class... Args>
+constexpr std::uint32_t PrefixTrie<i_from, Nodes, N, Args...>::find(std::string_view query) const {
+  std::uint32_t node = 0;
+  auto row = rows_[0];
+  for (const auto c : query) {
+    const auto first = first_children_[node];
+    const auto last = first + child_counts_[node];
+    auto child = first;
+    while (child < last && labels_[child] < c) {
+      ++child;
+    }
+    if (child == last || labels_[child] != c) {
+      break;
+    }
+    node = child;
+    if (rows_[node] != kNoRow) {
+      row = rows_[node];
+    }
+  }
+  return row;
+}
+
+template <std::size_t Capacity>
+constexpr PrefixTrieBuilder<Capacity>::PrefixTrieBuilder()
+    : size_(1), labels_(), first_children_(), next_siblings_() {}
+
+template <std::size_t Capacity>
+constexpr std::uint32_t PrefixTrieBuilder<Capacity>::insert(std::string_view key) {
+  std::uint32_t node = 0;
+  for (const auto c : key) {
+    // find child with label c.
+    auto child = first_children_[node];
+    auto previous = kNone;
+    while (child != kNone && labels_[child] < c) {
+      previous = child;
+      child = next_siblings_[child];
+    }
+    if (child == kNone || labels_[child] != c) {
+      if (size_ == Capacity) {
+        throw std::logic_error("Capacity is too small.");
+      }
+      labels_[size_] = c;
+      next_siblings_[size_] = child;
+      if (previous == kNone) {
+        first_children_[node] = size_;
+      } else {
+        next_siblings_[previous] = size_;
+      }
+      child = size_;
+      ++size_;
+    }
+    node = child;
+  }
+  return node;
+}
+
+template <std::size_t Capacity>
+constexpr std::uint32_t PrefixTrieBuilder<Capacity>::size() const {
+  return size_;
+}
+
+template <std::size_t Capacity>
+constexpr char PrefixTrieBuilder<Capacity>::label(std::uint32_t node) const {
+  return labels_[node];
+}
+
+template <std::size_t Capacity>
+constexpr std::uint32_t PrefixTrieBuilder<Capacity>::first_child(std::uint32_t node) const {
+  return first_children_[node];
+}
+
+template <std::size_t Capacity>
+constexpr std::uint32_t PrefixTrieBuilder<Capacity>::next_sibling(std::uint32_t node) const {
+  return next_siblings_[node];
+}
+
+template <std::size_t i_from, std::size_t N, class... Args>
+constexpr std::size_t prefix_trie_capacity(const ConstMapper<N, Args...> &mapper) {
+  std::size_t capacity = 1;
+  for (const auto &tuple : mapper.data()) {
+    capacity += std::string_view(std::get<i_from>(tuple)).size();
+  }
+  return capacity;
+}
+
+template <std::size_t i_from, std::size_t Capacity, std::size_t N, class... Args>
+constexpr std::size_t count_prefix_trie_nodes(const ConstMapper<N, Args...> &mapper) {
+  PrefixTrieBuilder<Capacity> builder;
+  for (const auto &tuple : mapper.data()) {
+    builder.insert(std::get<i_from>(tuple));
+  }
+  return builder.size();
+}
+
+template <const auto &map, std::size_t i_from>
+constexpr std::size_t count_prefix_trie_nodes() {
+  constexpr auto capacity = prefix_trie_capacity<i_from>(map);
+  return count_prefix_trie_nodes<i_from, capacity>(map);
+}
+
+template <std::size_t i_from, std::size_t Nodes, std::size_t N, class... Args>
+constexpr auto make_prefix_trie(const ConstMapper<N, Args...> &mapper) {
+  return PrefixTrie<i_from, Nodes, N, Args...>(mapper);
+}
+
+template <const auto &map, std::size_t i_from>
+constexpr auto make_prefix_trie() {
+  constexpr auto nodes = count_prefix_trie_nodes<map, i_from>();
+  return make_prefix_trie<i_from, nodes>(map);
+}
 }  // namespace const_mapper
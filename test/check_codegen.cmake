@@ -0,0 +1,113 @@
+# Check that lookups in test_codegen.cpp are optimized as expected.
+# usage: cmake -DOBJDUMP=<objdump> -DOBJECT=<object file of test_codegen.cpp> -P check_codegen.cmake
+cmake_minimum_required(VERSION 3.20)
+
+execute_process(
+  COMMAND ${OBJDUMP} -dr --no-show-raw-insn ${OBJECT}
+  OUTPUT_VARIABLE output
+  RESULT_VARIABLE result
+)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "failed to disassemble ${OBJECT}")
+endif()
+
+# x86-64 and AArch64 branch instructions.
+set(branch "(j[a-z]*|b|b\\.[a-z]+|bl|cbn?z|tbn?z)")
+set(call "(call[a-z]*|bl|blr)")
+
+string(REPLACE ";" "," output "${output}")
+string(REPLACE "\n" ";" lines "${output}")
+
+# Find loops in `instructions` of current function, and append errors or looped_functions.
+# Element of `instructions` is `<address>:<ret|branch|call|other>:<target address or empty>`.
+# Backward branch is a loop, unless its target runs straight to `ret` without any branch (shared return path).
+macro(check_loops)
+  foreach(instruction IN LISTS instructions)
+    string(REPLACE ":" ";" fields "${instruction}")
+    list(GET fields 0 address)
+    list(GET fields 1 kind)
+    list(GET fields 2 target)
+    if(kind STREQUAL "branch" AND NOT target STREQUAL "" AND target LESS_EQUAL address)
+      set(loop TRUE)
+      foreach(following IN LISTS instructions)
+        string(REPLACE ":" ";" following "${following}")
+        list(GET following 0 following_address)
+        list(GET following 1 following_kind)
+        if(following_address GREATER_EQUAL target)
+          if(following_kind STREQUAL "ret")
+            set(loop FALSE)
+            break()
+          elseif(NOT following_kind STREQUAL "other")
+            break()
+          endif()
+        endif()
+      endforeach()
+      if(loop)
+        if(function MATCHES "^unrolled_")
+          list(APPEND errors "${function}: lookup is a loop: branch at ${address} to ${target}")
+        else()
+          list(APPEND looped_functions ${function})
+        endif()
+      endif()
+    endif()
+  endforeach()
+  set(instructions "")
+endmacro()
+
+set(function "")
+set(functions "")
+set(looped_functions "")
+set(errors "")
+set(instructions "")
+foreach(line IN LISTS lines)
+  # cold parts split by compiler (e.g. `unrolled_to.cold`) are checked as a part of function.
+  if(line MATCHES "^[0-9a-f]+ <([A-Za-z0-9_]+)(\\.[A-Za-z0-9_.]+)?>:$")
+    set(next_function "${CMAKE_MATCH_1}")
+    check_loops()
+    set(function "${next_function}")
+    if(function MATCHES "^(folded|unrolled|looped)_" AND NOT function IN_LIST functions)
+      list(APPEND functions ${function})
+    endif()
+  elseif(function MATCHES "^folded_")
+    if(line MATCHES "^ *[0-9a-f]+:[ \t]+(${branch}|${call})[ \t]" OR line MATCHES "__cxa_")
+      list(APPEND errors "${function}: lookup is not folded: ${line}")
+    endif()
+  elseif(function MATCHES "^(unrolled|looped)_" AND line MATCHES "^ *([0-9a-f]+):[ \t]+([^ \t]+)")
+    math(EXPR address "0x${CMAKE_MATCH_1}")
+    set(mnemonic "${CMAKE_MATCH_2}")
+    set(target "")
+    if(mnemonic MATCHES "^ret")
+      set(kind "ret")
+    elseif(mnemonic MATCHES "^${call}$")
+      set(kind "call")
+    elseif(mnemonic MATCHES "^${branch}$")
+      set(kind "branch")
+      if(line MATCHES "[ \t,]([0-9a-f]+) <[^>]*>$")
+        math(EXPR target "0x${CMAKE_MATCH_1}")
+      endif()
+    else()
+      set(kind "other")
+    endif()
+    list(APPEND instructions "${address}:${kind}:${target}")
+  endif()
+endforeach()
+check_loops()
+
+foreach(function IN LISTS functions)
+  if(function MATCHES "^looped_")
+    if(NOT function IN_LIST looped_functions)
+      list(APPEND errors "${function}: no loop is found. checker may be broken.")
+    endif()
+  endif()
+endforeach()
+
+if(NOT functions)
+  message(FATAL_ERROR "no function is checked in ${OBJECT}")
+endif()
+if(errors)
+  string(REPLACE ";" "\n" errors "${errors}")
+  message(FATAL_ERROR "${errors}")
+endif()
+
+list(LENGTH functions count)
+message(STATUS "${count} functions are checked.")
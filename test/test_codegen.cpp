@@ -0,0 +1,79 @@
+/**
+ * Lookups checked by check_codegen.cmake.
+ * This file is compiled with optimization and its object file is disassembled.
+ *   folded_*   : lookup must be folded to constant. no branch, no call and no exception.
+ *   unrolled_* : lookup over small table must not be a loop. no backward branch.
+ *   looped_*   : lookup over large table is a loop. ensures that the checker can find loops.
+ */
+#include <cstdint>
+
+#include "const_mapper.hpp"
+
+using namespace const_mapper;
+
+namespace {
+constexpr auto map = ConstMapper<3, std::string_view, int, std::uint8_t>{{{
+    {"value_0", 0, 0},
+    {"value_1", 1, 10},
+    {"value_2", 2, 20},
+}}};
+
+constexpr auto pattern_map = ConstMapper<4, std::string_view, Range<int>, Anyable<int>>{{{
+    {"less2 & 1", {CompareType::LessThan, 2}, 1},
+    {"less2 & 2", {CompareType::LessThan, 2}, 2},
+    {"larger5", {CompareType::LargerThan, 5}, {}},
+    {"Any", {}, {}},
+}}};
+
+constexpr std::string_view key_str = "value_2";
+
+constexpr auto pattern = std::make_tuple(Result{}, 6, -1);
+
+constexpr auto large_map = [] {
+  std::array<std::tuple<int, int>, 1024> list{};
+  for (auto i = 0; i < 1024; ++i) {
+    std::get<0>(list[i]) = i * 3;  // assignment of std::tuple is not constexpr in C++17.
+    std::get<1>(list[i]) = -i;
+  }
+  return ConstMapper<1024, int, int>(list);
+}();
+}  // namespace
+
+extern "C" {
+int folded_to_index() { return map.to<1, 2>(20); }
+
+int folded_to_type() { return map.to<int, std::uint8_t>(20); }
+
+std::size_t folded_to_string() { return map.to<std::string_view, int>(1).size(); }
+
+std::size_t folded_pattern_match() { return pattern_map.pattern_match(std::make_tuple(Result{}, 6, -1)).size(); }
+
+int folded_pattern_match_2_results() {
+  const auto [value, any] = pattern_map.pattern_match(std::make_tuple(Result{}, Ignore{}, Result{}));
+  return static_cast<int>(value.size()) + *any.value();
+}
+
+int folded_to_ct() { return to_ct<map, int, std::uint8_t, 20>(); }
+
+int folded_to_ct_string() { return to_ct<map, int, std::string_view, key_str>(); }
+
+std::size_t folded_pattern_match_ct() { return pattern_match_ct<pattern_map, pattern>().size(); }
+
+int unrolled_to(std::uint8_t key) { return map.to<int, std::uint8_t>(key); }
+
+std::size_t unrolled_pattern_match(int range, int any) {
+  return pattern_map.pattern_match(std::make_tuple(Result{}, range, any)).size();
+}
+
+int looped_to(int key) { return large_map.to<1, 0>(key); }
+
+// `return` in loop body is placed between head of loop and backward branch.
+int looped_scan_early_return(int key) {
+  for (const auto &[k, v] : large_map.data()) {
+    if (__builtin_expect(k == key, 1)) {
+      return v;
+    }
+  }
+  return 0;
+}
+}
@@ -170,3 +170,356 @@ TEST(TestConstMapper, range) {
     EXPECT_EQ(value_str, expected);
   }
 }
+
+TEST(TestLearnedIndex, to) {
+  static constexpr auto map = ConstMapper<8, std::string_view, int, std::uint8_t>{{{
+      {"value_0", 40, 0},
+      {"value_1", -10, 1},
+      {"value_2", 7, 2},
+      {"value_3", 1000, 3},
+      {"value_4", 7, 4},
+      {"value_5", -300, 5},
+      {"value_6", 41, 6},
+      {"value_7", 0, 7},
+  }}};
+  constexpr auto index = make_learned_index<1, 3>(map);
+
+  {
+    constexpr auto value_str = index.to<0>(7);
+    constexpr auto expected = "value_2";  // first match in original order.
+    EXPECT_EQ(value_str, expected);
+  }
+  {
+    constexpr auto value_uint = index.to<std::uint8_t>(-300);
+    EXPECT_EQ(value_uint, 5);
+  }
+
+  for (const auto &tuple : map.data()) {
+    auto key = std::get<1>(tuple);
+    auto expected = map.to<std::string_view, int>(key);
+    EXPECT_EQ(index.to<std::string_view>(key), expected);
+  }
+
+  for (const auto key : {-301, -11, 1, 39, 42, 1001}) {
+    try {
+      index.to<0>(key);
+      EXPECT_TRUE(false);
+    } catch (const std::out_of_range &e) {
+      // expected here
+    } catch (const std::exception &e) {
+      EXPECT_TRUE(false);
+    }
+  }
+
+  constexpr auto stats = index.stats();
+  EXPECT_EQ(stats.segments, 3);
+  EXPECT_GT(stats.model_size, 0);
+}
+
+TEST(TestLearnedIndex, large) {
+  static constexpr auto size = 1000;
+  static const auto map = [] {
+    std::array<std::tuple<std::int64_t, int>, size> list{};
+    for (auto i = 0; i < size; ++i) {
+      const auto p = (i * 7) % size;  // shuffle
+      list[i] = {static_cast<std::int64_t>(p) * p * p, i};
+    }
+    return ConstMapper<size, std::int64_t, int>(list);
+  }();
+  const auto index = make_learned_index<0, 16>(map);
+
+  for (std::int64_t p = 0; p < size; ++p) {
+    auto expected = map.to<int, std::int64_t>(p * p * p);
+    EXPECT_EQ(index.to<int>(p * p * p), expected);
+    EXPECT_THROW(index.to<int>(p * p * p + 2), std::out_of_range);
+  }
+  EXPECT_EQ(index.stats().segments, 16);
+}
+
+TEST(TestKeyFilter, integral) {
+  static constexpr auto map = ConstMapper<4, std::string_view, int, std::uint8_t>{{{
+      {"value_0", 0, 0},
+      {"value_1", -1, 1},
+      {"value_2", -2, 2},
+      {"value_3", -3, 3},
+  }}};
+  constexpr auto filter = make_key_filter<1>(map);
+
+  {
+    constexpr auto value_str = filter.to<0>(-2);
+    constexpr auto expected = "value_2";
+    EXPECT_EQ(value_str, expected);
+  }
+  {
+    constexpr auto value_uint = filter.to<std::uint8_t>(-3);
+    EXPECT_EQ(value_uint, 3);
+  }
+
+  for (auto i = 0; i < 4; ++i) {
+    EXPECT_TRUE(filter.may_contain(-i));
+  }
+
+  try {
+    filter.to<0>(100);
+    EXPECT_TRUE(false);
+  } catch (const std::out_of_range &e) {
+    // expected here
+  } catch (const std::exception &e) {
+    EXPECT_TRUE(false);
+  }
+}
+
+TEST(TestKeyFilter, string_view) {
+  static constexpr auto map = ConstMapper<4, std::string_view, int>{{{
+      {"value_0", 0},
+      {"value_1", 1},
+      {"value_2", 2},
+      {"value_1", 3},
+  }}};
+  constexpr auto filter = make_key_filter<0>(map);
+
+  static_assert(filter.may_contain(std::string_view("value_1")));
+
+  for (auto i = 0; i < 3; ++i) {
+    auto string = "value_" + std::to_string(i);
+
+    EXPECT_TRUE(filter.may_contain(string));
+    EXPECT_EQ(filter.to<int>(string), i);
+  }
+
+  EXPECT_THROW(filter.to<int>(std::string_view("value_3")), std::out_of_range);
+
+  {
+    constexpr auto value = filter.find<int>(std::string_view("value_1"));
+    EXPECT_EQ(value, 1);
+  }
+  EXPECT_EQ(filter.find<1>(std::string_view("value_3")), std::nullopt);
+}
+
+TEST(TestKeyFilter, false_positive_rate) {
+  static constexpr auto size = 1000;
+  static const auto map = [] {
+    std::array<std::tuple<int, int>, size> list{};
+    for (auto i = 0; i < size; ++i) {
+      list[i] = {2 * i, i};
+    }
+    return ConstMapper<size, int, int>(list);
+  }();
+  const auto filter = make_key_filter<0, 12>(map);
+
+  auto false_positive = 0;
+  for (auto i = 0; i < size; ++i) {
+    EXPECT_TRUE(filter.may_contain(2 * i));
+    if (filter.may_contain(2 * i + 1)) {
+      ++false_positive;
+    }
+  }
+  EXPECT_LT(false_positive, size * 3 / 100);
+}
+
+namespace {
+enum class Color { Red, Green, Blue };
+}
+
+TEST(TestCompileTime, to_ct) {
+  static constexpr auto map = ConstMapper<3, std::string_view, int, Color>{{{
+      {"value_0", 0, Color::Red},
+      {"value_1", -1, Color::Green},
+      {"value_2", -2, Color::Blue},
+  }}};
+  static constexpr std::string_view key_str = "value_1";
+  static constexpr char key_chars[] = "value_2";
+  static constexpr int key_int = -2;
+
+  EXPECT_EQ((to_ct<map, 0, 1, -1>()), "value_1");
+  EXPECT_EQ((to_ct<map, 1, 0, key_str>()), -1);
+  EXPECT_EQ((to_ct<map, std::string_view, Color, Color::Blue>()), "value_2");
+  EXPECT_EQ((to_ct<map, Color, int, key_int>()), Color::Blue);
+  EXPECT_EQ((to_ct<map, int, std::string_view, key_str>()), -1);
+  EXPECT_EQ((to_ct<map, Color, std::string_view, key_chars>()), Color::Blue);
+  // missing key is compile error. see test_to_ct_missing_key.cpp.
+}
+
+TEST(TestCompileTime, pattern_match_ct) {
+  static constexpr auto map = ConstMapper<4, std::string_view, Range<int>, Anyable<int>>{{{
+      {"less2 & 1", {CompareType::LessThan, 2}, 1},
+      {"less2 & 2", {CompareType::LessThan, 2}, 2},
+      {"larger5", {CompareType::LargerThan, 5}, {}},
+      {"Any", {}, {}},
+  }}};
+  static constexpr auto pattern0 = std::make_tuple(Result{}, 1, 2);
+  static constexpr auto pattern1 = std::make_tuple(Result{}, 6, -1);
+  static constexpr auto pattern2 = std::make_tuple(Result{}, Ignore{}, Result{});
+
+  EXPECT_EQ((pattern_match_ct<map, pattern0>()), "less2 & 2");
+  EXPECT_EQ((pattern_match_ct<map, pattern1>()), "larger5");
+  {
+    constexpr auto value = pattern_match_ct<map, pattern2>();
+    constexpr auto expected = std::tuple<std::string_view, Anyable<int>>("less2 & 1", 1);
+    EXPECT_EQ(value, expected);
+  }
+}
+
+TEST(TestOverlayMapper, to) {
+  static constexpr auto map = ConstMapper<4, std::string_view, int, std::uint8_t>{{{
+      {"value_0", 0, 0},
+      {"value_1", -1, 1},
+      {"value_2", -2, 2},
+      {"value_3", -3, 3},
+  }}};
+  auto overlay = OverlayMapper(map);
+  EXPECT_TRUE(overlay.empty());
+
+  for (auto i = 0; i < 4; ++i) {
+    auto string = "value_" + std::to_string(i);
+    EXPECT_EQ((overlay.to<int, std::string_view>(string)), -i);
+  }
+
+  overlay.replace(1, {"value_1", -10, 1});
+  overlay.erase(2);
+  overlay.add({"value_4", -4, 4});
+  overlay.add({"value_0", 100, 0});  // delta is consulted before base.
+  EXPECT_FALSE(overlay.empty());
+
+  EXPECT_EQ((overlay.to<int, std::string_view>("value_0")), 100);
+  EXPECT_EQ((overlay.to<int, std::string_view>("value_1")), -10);
+  EXPECT_EQ((overlay.to<int, std::string_view>("value_3")), -3);
+  EXPECT_EQ((overlay.to<0, 2>(4)), "value_4");
+  EXPECT_THROW((overlay.to<int, std::string_view>("value_2")), std::out_of_range);
+
+  // base is not modified.
+  EXPECT_EQ((map.to<int, std::string_view>("value_1")), -1);
+
+  overlay.replace(1, {"value_1", -11, 1});
+  EXPECT_EQ((overlay.to<int, std::string_view>("value_1")), -11);
+  overlay.erase(1);
+  EXPECT_THROW((overlay.to<int, std::string_view>("value_1")), std::out_of_range);
+  overlay.replace(2, {"value_2", -20, 2});
+  EXPECT_EQ((overlay.to<int, std::string_view>("value_2")), -20);
+
+  EXPECT_THROW(overlay.replace(4, {"value_4", -4, 4}), std::out_of_range);
+  EXPECT_THROW(overlay.erase(4), std::out_of_range);
+
+  overlay.clear();
+  EXPECT_TRUE(overlay.empty());
+  EXPECT_EQ((overlay.to<int, std::string_view>("value_1")), -1);
+  EXPECT_THROW((overlay.to<int, std::string_view>("value_4")), std::out_of_range);
+}
+
+TEST(TestOverlayMapper, pattern_match) {
+  static constexpr auto map = ConstMapper<4, std::string_view, Range<int>, Anyable<int>>{{{
+      {"less2 & 1", {CompareType::LessThan, 2}, 1},
+      {"less2 & 2", {CompareType::LessThan, 2}, 2},
+      {"larger5", {CompareType::LargerThan, 5}, {}},
+      {"Any", {}, {}},
+  }}};
+  auto overlay = OverlayMapper(map);
+
+  EXPECT_EQ(overlay.pattern_match(std::make_tuple(Result{}, 1, 2)), "less2 & 2");
+
+  overlay.erase(1);
+  overlay.replace(2, {"larger4", {CompareType::LargerThan, 4}, {}});
+
+  EXPECT_EQ(overlay.pattern_match(std::make_tuple(Result{}, 1, 2)), "Any");
+  EXPECT_EQ(overlay.pattern_match(std::make_tuple(Result{}, 5, -1)), "larger4");
+  {
+    auto value = overlay.pattern_match(std::make_tuple(Result{}, Ignore{}, Result{}));
+    auto expected = std::tuple<std::string_view, Anyable<int>>("larger4", {});
+    EXPECT_EQ(value, expected);
+  }
+}
+
+TEST(TestPrefixTrie, prefix_match) {
+  static constexpr auto map = ConstMapper<7, std::string_view, int>{{{
+      {"/api/", 1},
+      {"/api/v2/", 2},
+      {"/api/v2/users", 3},
+      {"/static/", 4},
+      {"urn:isbn:", 5},
+      {"/api/v2/", 6},
+      {"", 0},
+  }}};
+  static constexpr auto trie = make_prefix_trie<map, 0>();
+
+  // root, "/api/v2/users", "static/" and "urn:isbn:".
+  static_assert(count_prefix_trie_nodes<map, 0>() == 1 + 13 + 7 + 9);
+
+  {
+    constexpr auto value = trie.prefix_match<int>("/api/v2/users/42");
+    EXPECT_EQ(value, 3);
+  }
+  EXPECT_EQ(trie.prefix_match<int>("/api/v2/"), 2);  // exact match. first row of same keys.
+  EXPECT_EQ(trie.prefix_match<int>("/api/v2/user"), 2);
+  EXPECT_EQ(trie.prefix_match<int>("/api/v1/"), 1);
+  EXPECT_EQ(trie.prefix_match<int>("/static/img.png"), 4);
+  EXPECT_EQ(trie.prefix_match<0>("urn:isbn:0451450523"), "urn:isbn:");
+  EXPECT_EQ(trie.prefix_match<int>("urn:issn:"), 0);  // empty key is prefix of any query.
+  EXPECT_EQ(trie.prefix_match<int>(""), 0);
+}
+
+TEST(TestPrefixTrie, not_found) {
+  static constexpr auto map = ConstMapper<3, std::string_view, int>{{{
+      {"abc", 1},
+      {"abd", 2},
+      {"b", 3},
+  }}};
+  constexpr auto nodes = count_prefix_trie_nodes<map, 0>();
+  constexpr auto trie = make_prefix_trie<0, nodes>(map);
+
+  EXPECT_EQ(trie.prefix_match<int>("abdd"), 2);
+  EXPECT_EQ(trie.prefix_match<int>("bb"), 3);
+  EXPECT_THROW(trie.prefix_match<int>("ab"), std::out_of_range);
+  EXPECT_THROW(trie.prefix_match<int>("c"), std::out_of_range);
+  EXPECT_THROW(trie.prefix_match<int>(""), std::out_of_range);
+}
+
+namespace {
+static constexpr auto many_routes_size = 600;
+
+/**
+ * Characters of keys "/r/0", "/r/1", ..., "/r/599". Each key uses 8 chars.
+ */
+static constexpr auto many_routes_chars = [] {
+  std::array<char, many_routes_size * 8> chars{};
+  for (auto i = 0; i < many_routes_size; ++i) {
+    auto *key = chars.data() + i * 8;
+    key[0] = '/';
+    key[1] = 'r';
+    key[2] = '/';
+    auto length = 3;
+    auto digits = i >= 100 ? 3 : (i >= 10 ? 2 : 1);
+    for (auto d = digits - 1, value = i; d >= 0; --d, value /= 10) {
+      key[length + d] = static_cast<char>('0' + value % 10);
+    }
+    length += digits;
+    key[7] = static_cast<char>(length);
+  }
+  return chars;
+}();
+
+static constexpr auto many_routes = [] {
+  std::array<std::tuple<std::string_view, int>, many_routes_size> list{};
+  for (auto i = 0; i < many_routes_size; ++i) {
+    const auto *key = many_routes_chars.data() + i * 8;
+    std::get<0>(list[i]) = std::string_view(key, static_cast<std::size_t>(key[7]));
+    std::get<1>(list[i]) = i;
+  }
+  return ConstMapper<many_routes_size, std::string_view, int>(list);
+}();
+}  // namespace
+
+TEST(TestPrefixTrie, many_keys) {
+  static constexpr auto trie = make_prefix_trie<many_routes, 0>();
+
+  // root, "/r/", 10 keys of 1 digit, 90 keys of 2 digits and 500 keys of 3 digits.
+  static_assert(count_prefix_trie_nodes<many_routes, 0>() == 1 + 3 + 10 + 90 + 500);
+
+  {
+    constexpr auto value = trie.prefix_match<int>("/r/123/detail");
+    EXPECT_EQ(value, 123);
+  }
+  EXPECT_EQ(trie.prefix_match<int>("/r/1234"), 123);
+  EXPECT_EQ(trie.prefix_match<int>("/r/7"), 7);
+  EXPECT_EQ(trie.prefix_match<int>("/r/789"), 78);
+  EXPECT_THROW(trie.prefix_match<int>("/r/"), std::out_of_range);
+}
@@ -1,6 +1,10 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <limits>
+#include <memory>
 #include <random>
+#include <vector>
 
 #include "const_mapper.hpp"
 
@@ -8,6 +12,90 @@ using namespace const_mapper;
 
 namespace {
 static constexpr auto loop = 10000000;
+
+static constexpr auto large_size = 1 << 17;
+
+/**
+ * Key of large table. not evenly spaced so that model needs several segments.
+ */
+constexpr int large_key(int i) { return (i / 64) * (i / 64) + i; }
+
+const ConstMapper<large_size, int, int> &large_map() {
+  static const auto map = [] {
+    auto list = std::make_unique<std::array<std::tuple<int, int>, large_size>>();
+    for (auto i = 0; i < large_size; ++i) {
+      const auto p = static_cast<int>((static_cast<std::int64_t>(i) * 7919) % large_size);  // shuffle
+      (*list)[i] = {large_key(p), p};
+    }
+    return ConstMapper<large_size, int, int>(*list);
+  }();
+  return map;
+}
+
+static constexpr auto miss_loop = loop / 10;
+
+static constexpr auto miss_size = 256;
+
+/**
+ * Table whose keys are multiples of 10. 90% of keys in [0, miss_size * 10) are missing.
+ */
+const ConstMapper<miss_size, int, int> &miss_map() {
+  static const auto map = [] {
+    std::array<std::tuple<int, int>, miss_size> list{};
+    for (auto i = 0; i < miss_size; ++i) {
+      list[i] = {i * 10, -i};
+    }
+    return ConstMapper<miss_size, int, int>(list);
+  }();
+  return map;
+}
+
+static constexpr auto overlay_loop = loop / 100;
+
+static constexpr auto overlay_size = 1000;
+
+const ConstMapper<overlay_size, int, int> &overlay_base_map() {
+  static const auto map = [] {
+    std::array<std::tuple<int, int>, overlay_size> list{};
+    for (auto i = 0; i < overlay_size; ++i) {
+      list[i] = {i, -i};
+    }
+    return ConstMapper<overlay_size, int, int>(list);
+  }();
+  return map;
+}
+
+static constexpr auto routes = ConstMapper<16, std::string_view, int>{{{
+    {"/", 0},
+    {"/api/", 1},
+    {"/api/v1/", 2},
+    {"/api/v1/users/", 3},
+    {"/api/v1/items/", 4},
+    {"/api/v2/", 5},
+    {"/api/v2/users/", 6},
+    {"/api/v2/items/", 7},
+    {"/api/v2/orders/", 8},
+    {"/static/", 9},
+    {"/static/img/", 10},
+    {"/docs/", 11},
+    {"urn:isbn:", 12},
+    {"urn:issn:", 13},
+    {"urn:uuid:", 14},
+    {"mailto:", 15},
+}}};
+
+static constexpr std::array<std::pair<std::string_view, int>, 10> route_queries = {{
+    {"/api/v2/users/42", 6},
+    {"/api/v2/items/7/detail", 7},
+    {"/api/v1/orders/1", 2},
+    {"/api/v3/", 1},
+    {"/static/img/logo.png", 10},
+    {"/static/app.js", 9},
+    {"/index.html", 0},
+    {"urn:isbn:0451450523", 12},
+    {"urn:uuid:6e8bc430", 14},
+    {"mailto:user@example.com", 15},
+}};
 }
 
 TEST(Performance, ref_std_unordered_map) {
@@ -103,3 +191,160 @@ TEST(Performance, const_mapper_pattern_match_pick_up_2_values) {
     EXPECT_EQ(value, expected);
   }
 }
+
+TEST(Performance, ref_sorted_search_large) {
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution distrib(0, large_size - 1);
+
+  auto sorted = std::vector<std::tuple<int, int>>(large_map().data().begin(), large_map().data().end());
+  std::sort(sorted.begin(), sorted.end());
+
+  for (auto j = 0; j < loop; ++j) {
+    auto i = distrib(gen);
+    auto key = large_key(i);
+    auto it = std::lower_bound(sorted.begin(), sorted.end(), std::make_tuple(key, std::numeric_limits<int>::min()));
+    EXPECT_EQ(std::get<1>(*it), i);
+  }
+}
+
+TEST(Performance, learned_index_large) {
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution distrib(0, large_size - 1);
+
+  static const auto index = make_learned_index<0, 256>(large_map());
+  const auto stats = index.stats();
+  RecordProperty("segments", static_cast<int>(stats.segments));
+  RecordProperty("max_error", static_cast<int>(stats.max_error));
+  RecordProperty("model_size", static_cast<int>(stats.model_size));
+
+  for (auto j = 0; j < loop; ++j) {
+    auto i = distrib(gen);
+    auto value = index.to<1>(large_key(i));
+    EXPECT_EQ(value, i);
+  }
+}
+
+TEST(Performance, ref_scan_90_percent_miss) {
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution distrib(0, miss_size * 10 - 1);
+
+  const auto &map = miss_map();
+
+  for (auto j = 0; j < miss_loop; ++j) {
+    auto key = distrib(gen);
+    auto value = std::optional<int>();
+    for (const auto &[k, v] : map.data()) {
+      if (k == key) {
+        value = v;
+        break;
+      }
+    }
+    EXPECT_EQ(value.has_value(), key % 10 == 0);
+  }
+}
+
+TEST(Performance, key_filter_find_90_percent_miss) {
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution distrib(0, miss_size * 10 - 1);
+
+  const auto &map = miss_map();
+  const auto filter = make_key_filter<0>(map);
+
+  auto miss = 0;
+  auto false_positive = 0;
+  for (auto j = 0; j < miss_loop; ++j) {
+    auto key = distrib(gen);
+    if (key % 10 != 0) {
+      ++miss;
+      if (filter.may_contain(key)) {
+        ++false_positive;
+      }
+    }
+    auto value = filter.find<1>(key);
+    EXPECT_EQ(value.has_value(), key % 10 == 0);
+  }
+  RecordProperty("false_positive_per_mille", false_positive * 1000 / miss);
+  EXPECT_LT(false_positive, miss * 3 / 100);
+}
+
+TEST(Performance, overlay_base) {
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution distrib(0, overlay_size - 1);
+
+  const auto &map = overlay_base_map();
+
+  for (auto j = 0; j < overlay_loop; ++j) {
+    auto i = distrib(gen);
+    auto value = map.to<1, 0>(i);
+    EXPECT_EQ(value, -i);
+  }
+}
+
+TEST(Performance, overlay_empty_delta) {
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution distrib(0, overlay_size - 1);
+
+  const auto overlay = OverlayMapper(overlay_base_map());
+
+  for (auto j = 0; j < overlay_loop; ++j) {
+    auto i = distrib(gen);
+    auto value = overlay.to<1, 0>(i);
+    EXPECT_EQ(value, -i);
+  }
+}
+
+TEST(Performance, overlay_1_percent_delta) {
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution distrib(0, overlay_size - 1);
+
+  auto overlay = OverlayMapper(overlay_base_map());
+  for (auto i = 0; i < overlay_size; i += 100) {
+    overlay.replace(i, {i, -i});
+  }
+
+  for (auto j = 0; j < overlay_loop; ++j) {
+    auto i = distrib(gen);
+    auto value = overlay.to<1, 0>(i);
+    EXPECT_EQ(value, -i);
+  }
+}
+
+TEST(Performance, ref_linear_starts_with) {
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution<std::size_t> distrib(0, route_queries.size() - 1);
+
+  for (auto j = 0; j < loop; ++j) {
+    const auto &[query, expected] = route_queries[distrib(gen)];
+    std::size_t longest = 0;
+    auto value = -1;
+    for (const auto &[key, route] : routes.data()) {
+      if (key.size() >= longest && query.substr(0, key.size()) == key) {
+        longest = key.size();
+        value = route;
+      }
+    }
+    EXPECT_EQ(value, expected);
+  }
+}
+
+TEST(Performance, prefix_trie) {
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution<std::size_t> distrib(0, route_queries.size() - 1);
+
+  static constexpr auto trie = make_prefix_trie<routes, 0>();
+
+  for (auto j = 0; j < loop; ++j) {
+    const auto &[query, expected] = route_queries[distrib(gen)];
+    auto value = trie.prefix_match<int>(query);
+    EXPECT_EQ(value, expected);
+  }
+}
@@ -0,0 +1,26 @@
+/**
+ * `to_ct` with missing key. This file must not be compiled, checked by `to_ct_missing_key` test.
+ * With TO_CT_KEY_FOUND, key is found and this file must be compiled, checked by `to_ct_key_found` test.
+ * It ensures that the failure comes from missing key, not from other errors.
+ */
+#include "const_mapper.hpp"
+
+using namespace const_mapper;
+
+namespace {
+enum class Color { Red, Green, Blue };
+
+constexpr auto map = ConstMapper<3, std::string_view, int, Color>{{{
+    {"value_0", 0, Color::Red},
+    {"value_1", -1, Color::Green},
+    {"value_2", -2, Color::Blue},
+}}};
+
+#ifdef TO_CT_KEY_FOUND
+constexpr auto key = Color::Blue;
+#else
+constexpr auto key = static_cast<Color>(3);
+#endif
+}  // namespace
+
+int to_ct_key() { return to_ct<map, int, Color, key>(); }